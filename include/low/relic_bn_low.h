@@ -60,6 +60,7 @@
 #else
 
 #include "relic_types.h"
+#include "relic_util.h"
 
 /*============================================================================*/
 /* Function prototypes                                                        */
@@ -305,6 +306,99 @@ void bn_div1_low(dig_t *c, dig_t *d, const dig_t *a, int size, dig_t digit);
 void bn_modn_low(dig_t *c, const dig_t *a, int sa, const dig_t *m, int sm,
 	dig_t u);
 
+/*============================================================================*/
+/* Inline definitions                                                         */
+/*============================================================================*/
+
+/**
+ * Selects the flavor of the Comba step used by the inline squaring body,
+ * preferring the MULX/ADX variant when the target advertises the extensions
+ * at compile time.
+ */
+#if defined(RLC_COMBA_STEP_MUL_ADX)
+#define RLC_BN_SQR_STEP(R2, R1, R0, A, B)									\
+	RLC_COMBA_STEP_MUL_ADX(R2, R1, R0, A, B)
+#else
+#define RLC_BN_SQR_STEP(R2, R1, R0, A, B)									\
+	RLC_COMBA_STEP_MUL(R2, R1, R0, A, B)
+#endif
+
+/**
+ * Squares a digit vector using Comba squaring. Kept inline in the header so
+ * that callers passing a compile-time constant size, such as the prime field
+ * backends squaring RLC_FP_DIGS digits, get both triangular loops fully
+ * unrolled and the accumulator triple scheduled in registers.
+ *
+ * The off-diagonal products a_i * a_j with i < j are accumulated first, one
+ * column at a time and without any doubling, so each column step is a plain
+ * multiply-accumulate. A single carry-propagating pass then computes
+ * c = 2 * c + sum(a_i^2 * B^(2i)), hoisting the per-product doubling and its
+ * carry correction out of the quadratic part entirely.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the digit vector to square.
+ * @param[in] size			- the number of digits to square.
+ */
+static inline void bn_sqrn_imp(dig_t *c, const dig_t *a, int size) {
+	int i, j;
+	const dig_t *tmpa, *tmpb;
+	dig_t r0, r1, r2, c0, c1, sl, sh, d, prev, carry;
+
+	/* Zero the accumulator. */
+	r0 = r1 = r2 = 0;
+
+	/* Comba pass over the off-diagonal products, one column per iteration. */
+	for (i = 0; i < size; i++, c++) {
+		tmpa = a;
+		tmpb = a + i;
+
+		/* Compute the number of additions in this column. */
+		for (j = 0; j < (i + 1) / 2; j++, tmpa++, tmpb--) {
+			RLC_BN_SQR_STEP(r2, r1, r0, *tmpa, *tmpb);
+		}
+		*c = r0;
+		r0 = r1;
+		r1 = r2;
+		r2 = 0;
+	}
+	for (i = 0; i < size; i++, c++) {
+		tmpa = a + (i + 1);
+		tmpb = a + (size - 1);
+
+		/* Compute the number of additions in this column. */
+		for (j = 0; j < (size - 1 - i) / 2; j++, tmpa++, tmpb--) {
+			RLC_BN_SQR_STEP(r2, r1, r0, *tmpa, *tmpb);
+		}
+		*c = r0;
+		r0 = r1;
+		r1 = r2;
+		r2 = 0;
+	}
+	c -= 2 * size;
+
+	/* Double the cross products and add the diagonal squares in one pass. */
+	prev = carry = 0;
+	for (i = 0; i < size; i++) {
+		RLC_MUL_DIG(sh, sl, a[i], a[i]);
+		d = (c[2 * i] << 1) | (prev >> (RLC_DIG - 1));
+		prev = c[2 * i];
+		r0 = d + sl;
+		c0 = (r0 < sl);
+		r1 = r0 + carry;
+		c1 = (r1 < r0);
+		carry = c0 | c1;
+		c[2 * i] = r1;
+		d = (c[2 * i + 1] << 1) | (prev >> (RLC_DIG - 1));
+		prev = c[2 * i + 1];
+		r0 = d + sh;
+		c0 = (r0 < sh);
+		r1 = r0 + carry;
+		c1 = (r1 < r0);
+		carry = c0 | c1;
+		c[2 * i + 1] = r1;
+	}
+}
+
 #endif /* !ASM */
 
 #endif /* !RLC_BN_LOW_H */
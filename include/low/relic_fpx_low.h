@@ -185,6 +185,23 @@ void fp2_muln_low(dv2_t c, const fp2_t a, const fp2_t b);
  */
 void fp2_mulm_low(fp2_t c, const fp2_t a, const fp2_t b);
 
+/**
+ * Multiplies two independent pairs of quadratic extension field elements with
+ * embedded modular reduction. Computes c0 = (a0 * b0) mod p and
+ * c1 = (a1 * b1) mod p. Callers with batches of independent products, such as
+ * line evaluations inside a pairing, should prefer this entry point so that
+ * backends with vector units can run both multiplications in lockstep.
+ *
+ * @param[out] c0			- the first result.
+ * @param[out] c1			- the second result.
+ * @param[in] a0			- the first element of the first product.
+ * @param[in] b0			- the second element of the first product.
+ * @param[in] a1			- the first element of the second product.
+ * @param[in] b1			- the second element of the second product.
+ */
+void fp2_mulm_low_batch2(fp2_t c0, fp2_t c1, const fp2_t a0, const fp2_t b0,
+		const fp2_t a1, const fp2_t b1);
+
 /**
  * Squares a quadratic extension element. Computes c = a * a.
  *
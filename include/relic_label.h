@@ -1825,6 +1825,7 @@
 #undef fp2_nord_low
 #undef fp2_muln_low
 #undef fp2_mulm_low
+#undef fp2_mulm_low_batch2
 #undef fp2_sqrn_low
 #undef fp2_sqrm_low
 #undef fp2_rdcn_low
@@ -1844,6 +1845,7 @@
 #define fp2_nord_low 	RLC_PREFIX(fp2_nord_low)
 #define fp2_muln_low 	RLC_PREFIX(fp2_muln_low)
 #define fp2_mulm_low 	RLC_PREFIX(fp2_mulm_low)
+#define fp2_mulm_low_batch2 	RLC_PREFIX(fp2_mulm_low_batch2)
 #define fp2_sqrn_low 	RLC_PREFIX(fp2_sqrn_low)
 #define fp2_sqrm_low 	RLC_PREFIX(fp2_sqrm_low)
 #define fp2_rdcn_low 	RLC_PREFIX(fp2_rdcn_low)
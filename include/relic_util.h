@@ -216,6 +216,68 @@
 	(R2) += (R1) < _s1;														\
 	(R2) += (_s1 < _r1);													\
 
+#if defined(__BMI2__) && defined(__ADX__) && (WSIZE == 64)
+
+/**
+ * Accumulates a double precision digit in a triple register variable using the
+ * MULX instruction and two carry chains kept in the CF and OF flags. MULX does
+ * not touch the flags register, so the whole carry bookkeeping stays in flags
+ * instead of being emulated with comparisons.
+ *
+ * @param[in,out] R2		- most significant word of the triple register.
+ * @param[in,out] R1		- middle word of the triple register.
+ * @param[in,out] R0		- lowest significant word of the triple register.
+ * @param[in] A				- the first digit to multiply.
+ * @param[in] B				- the second digit to multiply.
+ */
+#define RLC_COMBA_STEP_MUL_ADX(R2, R1, R0, A, B)							\
+	{																		\
+		dig_t _lo, _hi, _t;													\
+		__asm__ (															\
+			"mulxq %[b], %[lo], %[hi]\n\t"									\
+			"xorq %[t], %[t]\n\t"											\
+			"adcxq %[lo], %[r0]\n\t"										\
+			"adoxq %[hi], %[r1]\n\t"										\
+			"adcxq %[t], %[r1]\n\t"											\
+			"adoxq %[t], %[r2]\n\t"											\
+			"adcxq %[t], %[r2]\n\t"											\
+			: [r0] "+r" (R0), [r1] "+r" (R1), [r2] "+r" (R2),				\
+			  [lo] "=&r" (_lo), [hi] "=&r" (_hi), [t] "=&r" (_t)			\
+			: [b] "rm" (B), "d" (A)											\
+			: "cc");														\
+	}																		\
+
+/**
+ * Computes the step of a Comba squaring using the MULX instruction. The
+ * doubled product is formed in registers with a single shift pair, with the
+ * bit shifted out of the high word recovered from the carry flag.
+ *
+ * @param[in,out] R2		- most significant word of the triple register.
+ * @param[in,out] R1		- middle word of the triple register.
+ * @param[in,out] R0		- lowest significant word of the triple register.
+ * @param[in] A				- the first digit to multiply.
+ * @param[in] B				- the second digit to multiply.
+ */
+#define RLC_COMBA_STEP_SQR_ADX(R2, R1, R0, A, B)							\
+	{																		\
+		dig_t _lo, _hi, _t;													\
+		__asm__ (															\
+			"mulxq %[b], %[lo], %[hi]\n\t"									\
+			"xorq %[t], %[t]\n\t"											\
+			"shldq $1, %[lo], %[hi]\n\t"									\
+			"adcxq %[t], %[t]\n\t"											\
+			"shlq $1, %[lo]\n\t"											\
+			"addq %[lo], %[r0]\n\t"											\
+			"adcq %[hi], %[r1]\n\t"											\
+			"adcq %[t], %[r2]\n\t"											\
+			: [r0] "+r" (R0), [r1] "+r" (R1), [r2] "+r" (R2),				\
+			  [lo] "=&r" (_lo), [hi] "=&r" (_hi), [t] "=&r" (_t)			\
+			: [b] "rm" (B), "d" (A)											\
+			: "cc");														\
+	}																		\
+
+#endif /* __BMI2__ && __ADX__ */
+
 /**
  * Accumulates a single precision digit in a triple register variable.
  *
@@ -66,11 +66,9 @@ void arch_clean(void) {
 ull_t arch_cycles(void) {
 	uint_t hi, lo;
 	asm (
-		"cpuid\n\t"/*serialize*/
+		"lfence\n\t"/*wait for prior instructions to complete*/
 		"rdtsc\n\t"/*read the clock*/
-		"mov %%edx, %0\n\t"
-		"mov %%eax, %1\n\t"
-		: "=r" (hi), "=r" (lo):: "%rax", "%rbx", "%rcx", "%rdx"
+		: "=d" (hi), "=a" (lo)
 	);
 	return ((ull_t) lo) | (((ull_t) hi) << 32);
 }
@@ -101,5 +99,11 @@ ull_t arch_cycles(void) {
 #endif
 
 uint_t arch_lzcnt(dig_t x) {
+#if defined(__LZCNT__)
+	/* The target is known to have the instruction at compile time, so skip
+	 * the context lookup and the indirect call through lzcnt_ptr. */
+	return __builtin_ia32_lzcnt_u64((ull_t)x) - (8 * sizeof(ull_t) - WSIZE);
+#else
 	return core_get()->lzcnt_ptr((ull_t)x) - (8 * sizeof(ull_t) - WSIZE);
+#endif
 }
@@ -34,6 +34,95 @@
 #include "relic_bn_low.h"
 #include "relic_util.h"
 
+#if (ARCH == X64) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+/*============================================================================*/
+/* Private definitions                                                        */
+/*============================================================================*/
+
+/**
+ * Cutover point, in digits, from Comba to Karatsuba squaring, around the
+ * break-even observed for quadratic multiplication on 64-bit targets. Can be
+ * overridden through the CFLAGS configuration option.
+ */
+#ifndef BN_SQR_KARAT
+#define BN_SQR_KARAT		24
+#endif
+
+/**
+ * Squares a digit vector using one level of Karatsuba splitting, recursing
+ * through bn_sqrn_low for the three half-sized squarings. Writing
+ * a = al + ah * B with B = 2^(h * WSIZE), the result is assembled as
+ * c = al^2 + ((al + ah)^2 - al^2 - ah^2) * B + ah^2 * B^2.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the digit vector to square.
+ * @param[in] size			- the number of digits to square.
+ */
+static void bn_sqrn_karat(dig_t *c, const dig_t *a, int size) {
+	int i, h = size / 2, n1 = size - h;
+	dig_t t[n1], tm[2 * n1], tme, cc;
+
+	/* c = al^2 + ah^2 * B^2, written directly into the low and high halves. */
+	bn_sqrn_low(c, a, h);
+	bn_sqrn_low(c + 2 * h, a + h, n1);
+
+	/* t = al + ah, with al zero-padded when the size is odd and the carry of
+	 * the sum kept aside in tme. */
+	for (i = 0; i < h; i++) {
+		t[i] = a[i];
+	}
+	for (i = h; i < n1; i++) {
+		t[i] = 0;
+	}
+	tme = bn_addn_low(t, t, a + h, n1);
+
+	/* tm = (al + ah)^2 = t^2 + 2 * tme * t * B^n1 + tme * B^(2 * n1), with
+	 * tme accumulating the digit of weight B^(2 * n1). */
+	bn_sqrn_low(tm, t, n1);
+	if (tme > 0) {
+		tme += bn_addn_low(tm + n1, tm + n1, t, n1);
+		tme += bn_addn_low(tm + n1, tm + n1, t, n1);
+	}
+
+	/* tm = (al + ah)^2 - al^2 - ah^2 = 2 * al * ah, which is non-negative. */
+	tme -= bn_sub1_low(tm + 2 * h, tm + 2 * h,
+			bn_subn_low(tm, tm, c, 2 * h), 2 * (n1 - h));
+	tme -= bn_subn_low(tm, tm, c + 2 * h, 2 * n1);
+
+	/* c = c + tm * B, where the final carry is absorbed by the high digits. */
+	cc = bn_addn_low(c + h, c + h, tm, 2 * n1);
+	bn_add1_low(c + h + 2 * n1, c + h + 2 * n1, tme + cc,
+			2 * size - h - 2 * n1);
+}
+
+/**
+ * Stamps out a squaring kernel specialized for a fixed digit count. Passing
+ * the size as a literal lets the compiler unroll both triangular loops of the
+ * shared implementation.
+ *
+ * @param[in] N				- the number of digits to square.
+ */
+#define BN_SQRN_KERNEL(N)													\
+	static void bn_sqrn_low_##N(dig_t *c, const dig_t *a) {					\
+		bn_sqrn_imp(c, a, (N));											\
+	}																		\
+
+/* Kernels for the field sizes commonly configured at build time (256, 315/330,
+ * 381/384, 446/448, 511/512, 768 and 1024-bit primes on 64-bit targets).
+ * Stamping them statically gives the deployed digit count the same
+ * straight-line unrolled code a runtime code generator would emit, without
+ * allocating writable-executable pages at initialization. */
+BN_SQRN_KERNEL(4)
+BN_SQRN_KERNEL(5)
+BN_SQRN_KERNEL(6)
+BN_SQRN_KERNEL(7)
+BN_SQRN_KERNEL(8)
+BN_SQRN_KERNEL(12)
+BN_SQRN_KERNEL(16)
+
 /*============================================================================*/
 /* Public definitions                                                         */
 /*============================================================================*/
@@ -42,7 +131,48 @@ dig_t bn_sqra_low(dig_t *c, const dig_t *a, int size) {
 	int i;
 	dig_t c0, c1;
 
-#ifdef RLC_CONF_NODBL
+#if (ARCH == X64) && defined(__GNUC__)
+	unsigned long long lo, hi, r0;
+	unsigned char cf, df;
+	dig_t t, top;
+
+	t = a[0];
+
+	/* Accumulate this column with the square of a->dp[i]. */
+	RLC_MUL_DIG(hi, lo, t, t);
+	cf = _addcarry_u64(0, c[0], lo, &r0);
+	_addcarry_u64(cf, hi, 0, &hi);
+	c[0] = r0;
+
+	/* Update the carry. */
+	c0 = hi;
+	c1 = 0;
+
+	/* Version of the main loop keeping the addition chains under the carry
+	 * flag. The product is doubled with shifts so the doubling stays off the
+	 * flag chains, and the delayed carry re-enters as a carry-in, leaving two
+	 * short chains per iteration instead of one long serial one. */
+	for (i = 1; i < size; i++) {
+		RLC_MUL_DIG(hi, lo, t, a[i]);
+		top = hi >> (RLC_DIG - 1);
+		hi = (hi << 1) | (lo >> (RLC_DIG - 1));
+		lo = lo << 1;
+
+		/* First chain: the stored digit, with the old delayed carry folded
+		 * into the high word where its weight lands. */
+		cf = _addcarry_u64(0, lo, c[i], &lo);
+		cf = _addcarry_u64(cf, hi, c1, &hi);
+		top += cf;
+
+		/* Second chain: the running column carry. */
+		df = _addcarry_u64(0, lo, c0, &lo);
+		df = _addcarry_u64(df, hi, 0, &hi);
+		c[i] = lo;
+		c0 = hi;
+		/* The column sum fits 2 * RLC_DIG + 1 bits, so this is 0 or 1. */
+		c1 = top + df;
+	}
+#elif defined(RLC_CONF_NODBL)
 	dig_t r0, r1, _r0, _r1, s0, s1, t, t0, t1;
 
 	t = a[0];
@@ -100,51 +230,52 @@ dig_t bn_sqra_low(dig_t *c, const dig_t *a, int size) {
 	}
 #endif
 
+#if (ARCH == X64) && defined(__GNUC__)
+	/* Return the carry flag directly instead of rebuilding it from a
+	 * comparison on the stored digit. */
+	return c1 + _addcarry_u64(0, c[size], c0, (unsigned long long *)&c[size]);
+#else
 	c[size] += c0;
 	c1 += (c[size] < c0);
 	return c1;
+#endif
 }
 
 void bn_sqrn_low(dig_t *c, const dig_t *a, int size) {
-	int i, j;
-	const dig_t *tmpa, *tmpb;
-	dig_t r0, r1, r2;
-
-	/* Zero the accumulator. */
-	r0 = r1 = r2 = 0;
-
-	/* Comba squaring produces one column of the result per iteration. */
-	for (i = 0; i < size; i++, c++) {
-		tmpa = a;
-		tmpb = a + i;
-
-		/* Compute the number of additions in this column. */
-		j = (i + 1);
-		for (j = 0; j < (i + 1) / 2; j++, tmpa++, tmpb--) {
-			RLC_COMBA_STEP_SQR(r2, r1, r0, *tmpa, *tmpb);
-		}
-		if (!(i & 0x01)) {
-			RLC_COMBA_STEP_MUL(r2, r1, r0, *tmpa, *tmpa);
-		}
-		*c = r0;
-		r0 = r1;
-		r1 = r2;
-		r2 = 0;
+	/* Past the break-even point, split once and recurse for an O(n^1.58)
+	 * schedule instead of the quadratic Comba pass. */
+	if (size >= BN_SQR_KARAT) {
+		bn_sqrn_karat(c, a, size);
+		return;
 	}
-	for (i = 0; i < size; i++, c++) {
-		tmpa = a + (i + 1);
-		tmpb = a + (size - 1);
-
-		/* Compute the number of additions in this column. */
-		for (j = 0; j < (size - 1 - i) / 2; j++, tmpa++, tmpb--) {
-			RLC_COMBA_STEP_SQR(r2, r1, r0, *tmpa, *tmpb);
-		}
-		if (!((size - i) & 0x01)) {
-			RLC_COMBA_STEP_MUL(r2, r1, r0, *tmpa, *tmpa);
-		}
-		*c = r0;
-		r0 = r1;
-		r1 = r2;
-		r2 = 0;
+
+	/* Dispatch to a kernel unrolled for the digit counts that show up as
+	 * field sizes in practice, so that the compiler can schedule the
+	 * accumulator updates as straight-line code. */
+	switch (size) {
+		case 4:
+			bn_sqrn_low_4(c, a);
+			break;
+		case 5:
+			bn_sqrn_low_5(c, a);
+			break;
+		case 6:
+			bn_sqrn_low_6(c, a);
+			break;
+		case 7:
+			bn_sqrn_low_7(c, a);
+			break;
+		case 8:
+			bn_sqrn_low_8(c, a);
+			break;
+		case 12:
+			bn_sqrn_low_12(c, a);
+			break;
+		case 16:
+			bn_sqrn_low_16(c, a);
+			break;
+		default:
+			bn_sqrn_imp(c, a, size);
+			break;
 	}
 }
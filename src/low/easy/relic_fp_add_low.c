@@ -34,6 +34,88 @@
 #include "relic_fp_low.h"
 #include "relic_core.h"
 
+#if (ARCH == X64) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+/*============================================================================*/
+/* Private definitions                                                        */
+/*============================================================================*/
+
+/**
+ * Adds two digit vectors of the same size. On x86-64 the chain is carried in
+ * the flags register through _addcarry_u64, which compiles to a straight adc
+ * sequence; a single dependent chain cannot be split across the CF/OF pair,
+ * so no ADX variant exists. Other targets emulate the carry with comparisons.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the first digit vector to add.
+ * @param[in] b				- the second digit vector to add.
+ * @param[in] size			- the number of digits to add.
+ * @return the carry of the last addition.
+ */
+static inline dig_t fp_addn_impl(dig_t *c, const dig_t *a, const dig_t *b,
+		int size) {
+	int i;
+
+#if (ARCH == X64) && defined(__GNUC__)
+	unsigned char cf = 0;
+
+	for (i = 0; i < size; i++) {
+		cf = _addcarry_u64(cf, a[i], b[i], (unsigned long long *)(c + i));
+	}
+	return cf;
+#else
+	dig_t carry, c0, c1, r0, r1;
+
+	carry = 0;
+	for (i = 0; i < size; i++, a++, b++) {
+		r0 = (*a) + (*b);
+		c0 = (r0 < (*a));
+		r1 = r0 + carry;
+		c1 = (r1 < r0);
+		carry = c0 | c1;
+		c[i] = r1;
+	}
+	return carry;
+#endif
+}
+
+/**
+ * Subtracts a digit vector from another of the same size, borrowing through
+ * the flags register on x86-64 and through comparisons elsewhere.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the digit vector to subtract from.
+ * @param[in] b				- the digit vector to subtract.
+ * @param[in] size			- the number of digits to subtract.
+ * @return the borrow of the last subtraction.
+ */
+static inline dig_t fp_subn_impl(dig_t *c, const dig_t *a, const dig_t *b,
+		int size) {
+	int i;
+
+#if (ARCH == X64) && defined(__GNUC__)
+	unsigned char bf = 0;
+
+	for (i = 0; i < size; i++) {
+		bf = _subborrow_u64(bf, a[i], b[i], (unsigned long long *)(c + i));
+	}
+	return bf;
+#else
+	dig_t carry, r0, diff;
+
+	carry = 0;
+	for (i = 0; i < size; i++, a++, b++) {
+		diff = (*a) - (*b);
+		r0 = diff - carry;
+		carry = ((*a) < (*b)) || (carry && !diff);
+		c[i] = r0;
+	}
+	return carry;
+#endif
+}
+
 /*============================================================================*/
 /* Public definitions                                                         */
 /*============================================================================*/
@@ -55,53 +137,19 @@ dig_t fp_add1_low(dig_t *c, const dig_t *a, dig_t digit) {
 }
 
 dig_t fp_addn_low(dig_t *c, const dig_t *a, const dig_t *b) {
-	int i;
-	dig_t carry, c0, c1, r0, r1;
-
-	carry = 0;
-	for (i = 0; i < RLC_FP_DIGS; i++, a++, b++, c++) {
-		r0 = (*a) + (*b);
-		c0 = (r0 < (*a));
-		r1 = r0 + carry;
-		c1 = (r1 < r0);
-		carry = c0 | c1;
-		(*c) = r1;
-	}
-	return carry;
+	return fp_addn_impl(c, a, b, RLC_FP_DIGS);
 }
 
 void fp_addm_low(dig_t *c, const dig_t *a, const dig_t *b) {
-	int i;
-	dig_t carry, c0, c1, r0, r1;
+	dig_t carry = fp_addn_impl(c, a, b, RLC_FP_DIGS);
 
-	carry = 0;
-	for (i = 0; i < RLC_FP_DIGS; i++, a++, b++) {
-		r0 = (*a) + (*b);
-		c0 = (r0 < (*a));
-		r1 = r0 + carry;
-		c1 = (r1 < r0);
-		carry = c0 | c1;
-		c[i] = r1;
-	}
 	if (carry || (dv_cmp(c, fp_prime_get(), RLC_FP_DIGS) != RLC_LT)) {
 		carry = fp_subn_low(c, c, fp_prime_get());
 	}
 }
 
 dig_t fp_addd_low(dig_t *c, const dig_t *a, const dig_t *b) {
-	int i;
-	dig_t carry, c0, c1, r0, r1;
-
-	carry = 0;
-	for (i = 0; i < 2 * RLC_FP_DIGS; i++, a++, b++) {
-		r0 = (*a) + (*b);
-		c0 = (r0 < (*a));
-		r1 = r0 + carry;
-		c1 = (r1 < r0);
-		carry = c0 | c1;
-		c[i] = r1;
-	}
-	return carry;
+	return fp_addn_impl(c, a, b, 2 * RLC_FP_DIGS);
 }
 
 void fp_addc_low(dig_t *c, const dig_t *a, const dig_t *b) {
@@ -126,33 +174,11 @@ dig_t fp_sub1_low(dig_t *c, const dig_t *a, dig_t digit) {
 }
 
 dig_t fp_subn_low(dig_t *c, const dig_t *a, const dig_t *b) {
-	int i;
-	dig_t carry, r0, diff;
-
-	/* Zero the carry. */
-	carry = 0;
-	for (i = 0; i < RLC_FP_DIGS; i++, a++, b++, c++) {
-		diff = (*a) - (*b);
-		r0 = diff - carry;
-		carry = ((*a) < (*b)) || (carry && !diff);
-		(*c) = r0;
-	}
-	return carry;
+	return fp_subn_impl(c, a, b, RLC_FP_DIGS);
 }
 
 void fp_subm_low(dig_t *c, const dig_t *a, const dig_t *b) {
-	int i;
-	dig_t carry, r0, diff;
-
-	/* Zero the carry. */
-	carry = 0;
-	for (i = 0; i < RLC_FP_DIGS; i++, a++, b++) {
-		diff = (*a) - (*b);
-		r0 = diff - carry;
-		carry = ((*a) < (*b)) || (carry && !diff);
-		c[i] = r0;
-	}
-	if (carry) {
+	if (fp_subn_impl(c, a, b, RLC_FP_DIGS)) {
 		fp_addn_low(c, c, fp_prime_get());
 	}
 }
@@ -164,18 +190,7 @@ void fp_subc_low(dig_t *c, const dig_t *a, const dig_t *b) {
 }
 
 dig_t fp_subd_low(dig_t *c, const dig_t *a, const dig_t *b) {
-	int i;
-	dig_t carry, r0, diff;
-
-	/* Zero the carry. */
-	carry = 0;
-	for (i = 0; i < 2 * RLC_FP_DIGS; i++, a++, b++) {
-		diff = (*a) - (*b);
-		r0 = diff - carry;
-		carry = ((*a) < (*b)) || (carry && !diff);
-		c[i] = r0;
-	}
-	return carry;
+	return fp_subn_impl(c, a, b, 2 * RLC_FP_DIGS);
 }
 
 void fp_negm_low(dig_t *c, const dig_t *a) {
@@ -187,34 +202,12 @@ void fp_negm_low(dig_t *c, const dig_t *a) {
 }
 
 dig_t fp_dbln_low(dig_t *c, const dig_t *a) {
-	int i;
-	dig_t carry, c0, c1, r0, r1;
-
-	carry = 0;
-	for (i = 0; i < RLC_FP_DIGS; i++, a++, c++) {
-		r0 = (*a) + (*a);
-		c0 = (r0 < (*a));
-		r1 = r0 + carry;
-		c1 = (r1 < r0);
-		carry = c0 | c1;
-		(*c) = r1;
-	}
-	return carry;
+	return fp_addn_impl(c, a, a, RLC_FP_DIGS);
 }
 
 void fp_dblm_low(dig_t *c, const dig_t *a) {
-	int i;
-	dig_t carry, c0, c1, r0, r1;
+	dig_t carry = fp_addn_impl(c, a, a, RLC_FP_DIGS);
 
-	carry = 0;
-	for (i = 0; i < RLC_FP_DIGS; i++, a++) {
-		r0 = (*a) + (*a);
-		c0 = (r0 < (*a));
-		r1 = r0 + carry;
-		c1 = (r1 < r0);
-		carry = c0 | c1;
-		c[i] = r1;
-	}
 	if (carry || (dv_cmp(c, fp_prime_get(), RLC_FP_DIGS) != RLC_LT)) {
 		carry = fp_subn_low(c, c, fp_prime_get());
 	}
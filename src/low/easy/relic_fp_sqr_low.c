@@ -31,52 +31,16 @@
 
 #include "relic_fp.h"
 #include "relic_fp_low.h"
+#include "relic_bn_low.h"
 
 /*============================================================================*/
 /* Public definitions                                                         */
 /*============================================================================*/
 
 void fp_sqrn_low(dig_t *c, const dig_t *a) {
-	int i, j;
-	const dig_t *tmpa, *tmpb;
-	dig_t r0, r1, r2;
-
-	/* Zero the accumulator. */
-	r0 = r1 = r2 = 0;
-
-	/* Comba squaring produces one column of the result per iteration. */
-	for (i = 0; i < RLC_FP_DIGS; i++, c++) {
-		tmpa = a;
-		tmpb = a + i;
-
-		/* Compute the number of additions in this column. */
-		for (j = 0; j < (i + 1) / 2; j++, tmpa++, tmpb--) {
-			RLC_COMBA_STEP_SQR(r2, r1, r0, *tmpa, *tmpb);
-		}
-		if (!(i & 0x01)) {
-			RLC_COMBA_STEP_MUL(r2, r1, r0, *tmpa, *tmpa);
-		}
-		*c = r0;
-		r0 = r1;
-		r1 = r2;
-		r2 = 0;
-	}
-	for (i = 0; i < RLC_FP_DIGS; i++, c++) {
-		tmpa = a + (i + 1);
-		tmpb = a + (RLC_FP_DIGS - 1);
-
-		/* Compute the number of additions in this column. */
-		for (j = 0; j < (RLC_FP_DIGS - 1 - i) / 2; j++, tmpa++, tmpb--) {
-			RLC_COMBA_STEP_SQR(r2, r1, r0, *tmpa, *tmpb);
-		}
-		if (!((RLC_FP_DIGS - i) & 0x01)) {
-			RLC_COMBA_STEP_MUL(r2, r1, r0, *tmpa, *tmpa);
-		}
-		*c = r0;
-		r0 = r1;
-		r1 = r2;
-		r2 = 0;
-	}
+	/* The size is a compile-time constant here, so the inline Comba body is
+	 * instantiated with constant trip counts and fully unrolled. */
+	bn_sqrn_imp(c, a, RLC_FP_DIGS);
 }
 
 void fp_sqrm_low(dig_t *c, const dig_t *a) {
@@ -35,56 +35,233 @@
 #include "relic_fpx_low.h"
 
 /*============================================================================*/
-/* Public definitions                                                         */
+/* Private definitions                                                        */
 /*============================================================================*/
 
-void fp2_muln_low(dv2_t c, const fp2_t a, const fp2_t b) {
-	rlc_align dig_t t0[2 * RLC_FP_DIGS], t1[2 * RLC_FP_DIGS], t2[2 * RLC_FP_DIGS];
+/**
+ * Subtracts a small multiple of a double-precision field element, computing
+ * c = a - k * b for a digit k in a single pass over the operands. The result
+ * is corrected by adding 2^(RLC_FP_DIGS * WSIZE) * p until it becomes
+ * non-negative, matching the effect of k chained fp_subc_low calls while
+ * reading and writing the temporaries only once.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the first field element.
+ * @param[in] b				- the field element to subtract.
+ * @param[in] k				- the multiple of the element to subtract.
+ */
+static void fp_subc_mul_low(dig_t *c, const dig_t *a, const dig_t *b, dig_t k) {
+	int i;
+	dig_t borrow, diff, r0, s0, s1, mc, u;
 
-	/* Karatsuba algorithm. */
+	borrow = mc = 0;
+	for (i = 0; i < 2 * RLC_FP_DIGS; i++) {
+		/* Compute the next digit of k * b. */
+		RLC_MUL_DIG(s1, s0, b[i], k);
+		s0 += mc;
+		s1 += (s0 < mc);
+		mc = s1;
+		/* Subtract it from a with the running borrow. */
+		diff = a[i] - s0;
+		r0 = diff - borrow;
+		borrow = (a[i] < s0) || (borrow && !diff);
+		c[i] = r0;
+	}
+	/* Each pending unit of 2^(2 * RLC_FP_DIGS * WSIZE) is cancelled by the
+	 * carry out of an addition of 2^(RLC_FP_DIGS * WSIZE) * p, leaving the
+	 * smallest non-negative representative. */
+	u = mc + borrow;
+	while (u > 0) {
+		u -= fp_addn_low(c + RLC_FP_DIGS, c + RLC_FP_DIGS, fp_prime_get());
+	}
+}
+
+/**
+ * Adds a small multiple of a double-precision field element, computing
+ * c = a + k * b for a digit k in a single pass over the operands. The result
+ * is corrected by subtracting 2^(RLC_FP_DIGS * WSIZE) * p until it fits the
+ * double-precision representation, matching k chained fp_addc_low calls.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the first field element.
+ * @param[in] b				- the field element to add.
+ * @param[in] k				- the multiple of the element to add.
+ */
+static void fp_addc_mul_low(dig_t *c, const dig_t *a, const dig_t *b, dig_t k) {
+	int i;
+	dig_t carry, r0, r1, s0, s1, mc, u;
+
+	carry = mc = 0;
+	for (i = 0; i < 2 * RLC_FP_DIGS; i++) {
+		/* Compute the next digit of k * b. */
+		RLC_MUL_DIG(s1, s0, b[i], k);
+		s0 += mc;
+		s1 += (s0 < mc);
+		mc = s1;
+		/* Add it to a with the running carry. */
+		r0 = a[i] + s0;
+		r1 = r0 + carry;
+		carry = (r0 < s0) || (r1 < r0);
+		c[i] = r1;
+	}
+	u = mc + carry;
+	while (u > 0) {
+		u -= fp_subn_low(c + RLC_FP_DIGS, c + RLC_FP_DIGS, fp_prime_get());
+	}
+	while (dv_cmp(c + RLC_FP_DIGS, fp_prime_get(), RLC_FP_DIGS) != RLC_LT) {
+		fp_subn_low(c + RLC_FP_DIGS, c + RLC_FP_DIGS, fp_prime_get());
+	}
+}
+
+/**
+ * Subtracts two double-precision field elements from a third in a single
+ * pass, computing c = a - b0 - b1. The result is corrected by adding
+ * 2^(RLC_FP_DIGS * WSIZE) * p until it becomes non-negative, matching an
+ * fp_addc_low of the subtrahends followed by an fp_subc_low while streaming
+ * the operands through memory only once.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the field element to subtract from.
+ * @param[in] b0			- the first field element to subtract.
+ * @param[in] b1			- the second field element to subtract.
+ */
+static void fp_subc2_low(dig_t *c, const dig_t *a, const dig_t *b0,
+		const dig_t *b1) {
+	int i;
+	dig_t borrow, d0, d1, d2, u;
+
+	borrow = 0;
+	for (i = 0; i < 2 * RLC_FP_DIGS; i++) {
+		/* The combined borrow fits a digit, as the limb deficit is at most
+		 * two subtrahend limbs plus the incoming borrow. */
+		d0 = a[i] - b0[i];
+		d1 = d0 - b1[i];
+		d2 = d1 - borrow;
+		borrow = (a[i] < b0[i]) + (d0 < b1[i]) + (d1 < borrow);
+		c[i] = d2;
+	}
+	u = borrow;
+	while (u > 0) {
+		u -= fp_addn_low(c + RLC_FP_DIGS, c + RLC_FP_DIGS, fp_prime_get());
+	}
+}
+
+/**
+ * Multiplies the sums of two pairs of field elements, computing
+ * c = (a0 + a1) * (b0 + b1). The operand sums are kept in small stack buffers
+ * local to this call instead of being materialized in the caller's
+ * double-precision temporaries, so they stay L1-resident across the
+ * multiplication.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a0			- the first element of the first sum.
+ * @param[in] a1			- the second element of the first sum.
+ * @param[in] b0			- the first element of the second sum.
+ * @param[in] b1			- the second element of the second sum.
+ */
+static void fp_muln_add_low(dig_t *c, const dig_t *a0, const dig_t *a1,
+		const dig_t *b0, const dig_t *b1) {
+	rlc_align dig_t sa[RLC_FP_DIGS], sb[RLC_FP_DIGS];
 
-	/* t0 = a_0 + a_1, t1 = b_0 + b_1. */
 #ifdef RLC_FP_ROOM
-	fp_addn_low(t0, a[0], a[1]);
-	fp_addn_low(t1, b[0], b[1]);
+	fp_addn_low(sa, a0, a1);
+	fp_addn_low(sb, b0, b1);
 #else
-	fp_addm_low(t0, a[0], a[1]);
-	fp_addm_low(t1, b[0], b[1]);
+	fp_addm_low(sa, a0, a1);
+	fp_addm_low(sb, b0, b1);
 #endif
-	/* c_0 = a_0 * b_0, c_1 = a_1 * b_1. */
+	fp_muln_low(c, sa, sb);
+}
+
+/*============================================================================*/
+/* Public definitions                                                         */
+/*============================================================================*/
+
+/**
+ * Multiplies two quadratic extension field elements for towers built with
+ * i^2 = -1, so the non-residue folds into a single subtraction. This is the
+ * hot path for most supported curves and carries no reference to the
+ * configured non-residue.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the first field element to multiply.
+ * @param[in] b				- the second field element to multiply.
+ */
+static void fp2_muln_qnres(dv2_t c, const fp2_t a, const fp2_t b) {
+	rlc_align dig_t t0[2 * RLC_FP_DIGS], t2[2 * RLC_FP_DIGS];
+
+	/* Karatsuba algorithm. */
+
+	/* t2 = (a_0 + a_1) * (b_0 + b_1), with the operand sums kept local to the
+	 * fused primitive, c_0 = a_0 * b_0, t0 = a_1 * b_1. */
+	fp_muln_add_low(t2, a[0], a[1], b[0], b[1]);
 	fp_muln_low(c[0], a[0], b[0]);
-	fp_muln_low(c[1], a[1], b[1]);
-	/* t2 = (a_0 + a_1) * (b_0 + b_1). */
-	fp_muln_low(t2, t0, t1);
+	fp_muln_low(t0, a[1], b[1]);
 
-	/* t0 = (a_0 * b_0) + (a_1 * b_1). */
-#ifdef RLC_FP_ROOM
-	fp_addd_low(t0, c[0], c[1]);
-#else
-	fp_addc_low(t0, c[0], c[1]);
-#endif
+	/* c_1 = t2 - (a_0 * b_0) - (a_1 * b_1), without summing the products into
+	 * a temporary first. */
+	fp_subc2_low(c[1], t2, c[0], t0);
 
-	/* c_0 = (a_0 * b_0) + u^2 * (a_1 * b_1). */
-	fp_subc_low(c[0], c[0], c[1]);
+	/* c_0 = (a_0 * b_0) - (a_1 * b_1). */
+	fp_subc_low(c[0], c[0], t0);
+}
 
 #ifndef FP_QNRES
-	/* t1 = u^2 * (a_1 * b_1). */
-	for (int i = -1; i > fp_prime_get_qnr(); i--) {
-		fp_subc_low(c[0], c[0], c[1]);
-	}
-#endif
 
-	/* c_1 = t2 - t0. */
-#ifdef RLC_FP_ROOM
-	fp_subd_low(c[1], t2, t0);
+/**
+ * Multiplies two quadratic extension field elements for an arbitrary
+ * quadratic non-residue read from the prime context.
+ *
+ * @param[out] c			- the result.
+ * @param[in] a				- the first field element to multiply.
+ * @param[in] b				- the second field element to multiply.
+ */
+static void fp2_muln_generic(dv2_t c, const fp2_t a, const fp2_t b) {
+	rlc_align dig_t t0[2 * RLC_FP_DIGS], t2[2 * RLC_FP_DIGS];
+
+	/* Karatsuba algorithm. */
+
+	/* t2 = (a_0 + a_1) * (b_0 + b_1), with the operand sums kept local to the
+	 * fused primitive, c_0 = a_0 * b_0, t0 = a_1 * b_1. */
+	fp_muln_add_low(t2, a[0], a[1], b[0], b[1]);
+	fp_muln_low(c[0], a[0], b[0]);
+	fp_muln_low(t0, a[1], b[1]);
+
+	/* c_1 = t2 - (a_0 * b_0) - (a_1 * b_1), without summing the products into
+	 * a temporary first. */
+	fp_subc2_low(c[1], t2, c[0], t0);
+
+	/* c_0 = (a_0 * b_0) + qnr * (a_1 * b_1), in a single pass over c_0. */
+	fp_subc_mul_low(c[0], c[0], t0, (dig_t)(-fp_prime_get_qnr()));
+}
+
+#endif /* !FP_QNRES */
+
+void fp2_muln_low(dv2_t c, const fp2_t a, const fp2_t b) {
+#ifdef FP_QNRES
+	fp2_muln_qnres(c, a, b);
 #else
-	fp_subc_low(c[1], t2, t0);
+	/* The non-residue is fixed at prime setup, so this predicts perfectly
+	 * and keeps the correction chain out of the common path. */
+	if (fp_prime_get_qnr() == -1) {
+		fp2_muln_qnres(c, a, b);
+	} else {
+		fp2_muln_generic(c, a, b);
+	}
 #endif
 }
 
 void fp2_mulm_low(fp2_t c, const fp2_t a, const fp2_t b) {
+#if ALLOC == AUTO
+	/* The temporary lives on the stack and cannot fail to allocate, so skip
+	 * the exception frame entirely in this hot path. */
 	rlc_align dv2_t t;
 
+	fp2_muln_low(t, a, b);
+	fp2_rdcn_low(c, t);
+#else
+	dv2_t t;
+
 	dv2_null(t);
 
 	RLC_TRY {
@@ -96,82 +273,68 @@ void fp2_mulm_low(fp2_t c, const fp2_t a, const fp2_t b) {
 	} RLC_FINALLY {
 		dv2_free(t);
 	}
+#endif
+}
+
+void fp2_mulm_low_batch2(fp2_t c0, fp2_t c1, const fp2_t a0, const fp2_t b0,
+		const fp2_t a1, const fp2_t b1) {
+	/* The portable backend has no vector unit to pack the two products into,
+	 * so the batch runs sequentially. The entry point still lets callers
+	 * group independent multiplications, which lane-packed backends (e.g.
+	 * 52-bit limbs over AVX-512 IFMA) can pick up without interface changes. */
+	fp2_mulm_low(c0, a0, b0);
+	fp2_mulm_low(c1, a1, b1);
 }
 
 void fp3_muln_low(dv3_t c, const fp3_t a, const fp3_t b) {
-	rlc_align dig_t t0[2 * RLC_FP_DIGS], t1[2 * RLC_FP_DIGS], t2[2 * RLC_FP_DIGS], t3[2 * RLC_FP_DIGS];
-	rlc_align dig_t t4[2 * RLC_FP_DIGS], t5[2 * RLC_FP_DIGS], t6[2 * RLC_FP_DIGS];
+	rlc_align dig_t t2[2 * RLC_FP_DIGS], t4[2 * RLC_FP_DIGS],
+			t5[2 * RLC_FP_DIGS];
+	int cnr = fp_prime_get_cnr();
 
-	/* Karatsuba algorithm. */
+	/* Karatsuba algorithm, with the half products parked in the result
+	 * coefficients so only three scratch buffers stay live. */
 
-	/* t0 = a_0 * b_0, t1 = a_1 * b_1, t2 = a_2 * b_2. */
-	fp_muln_low(t0, a[0], b[0]);
-	fp_muln_low(t1, a[1], b[1]);
+	/* c_0 = a_0 * b_0, c_1 = a_1 * b_1, t2 = a_2 * b_2. */
+	fp_muln_low(c[0], a[0], b[0]);
+	fp_muln_low(c[1], a[1], b[1]);
 	fp_muln_low(t2, a[2], b[2]);
 
-	/* t3 = (a_1 + a_2) * (b_1 + b_2). */
-#ifdef RLC_FP_ROOM
-	fp_addn_low(t3, a[1], a[2]);
-	fp_addn_low(t4, b[1], b[2]);
-#else
-	fp_addm_low(t3, a[1], a[2]);
-	fp_addm_low(t4, b[1], b[2]);
-#endif
-	fp_muln_low(t5, t3, t4);
-#ifdef RLC_FP_ROOM
-	fp_addc_low(t6, t1, t2);
-#else
-	fp_addc_low(t6, t1, t2);
-#endif
-	fp_subc_low(t4, t5, t6);
-	fp_addc_low(c[0], t0, t4);
-	for (int i = 1; i < fp_prime_get_cnr(); i++) {
-		fp_addc_low(c[0], c[0], t4);
-	}
-	for (int i = 0; i >= fp_prime_get_cnr(); i--) {
-		fp_subc_low(c[0], c[0], t4);
-	}
+	/* c_2 = (a_0 + a_2) * (b_0 + b_2) - c_0 - t2 + c_1, finished first while
+	 * the half products are still in place. */
+	fp_muln_add_low(c[2], a[0], a[2], b[0], b[2]);
+	fp_subc2_low(c[2], c[2], c[0], t2);
+	fp_addc_low(c[2], c[2], c[1]);
 
-#ifdef RLC_FP_ROOM
-	fp_addn_low(t4, a[0], a[1]);
-	fp_addn_low(t5, b[0], b[1]);
-#else
-	fp_addm_low(t4, a[0], a[1]);
-	fp_addm_low(t5, b[0], b[1]);
-#endif
-	fp_muln_low(t6, t4, t5);
-#ifdef RLC_FP_ROOM
-	fp_addc_low(t4, t0, t1);
-#else
-	fp_addc_low(t4, t0, t1);
-#endif
-	fp_subc_low(t4, t6, t4);
-	fp_addc_low(c[1], t4, t2);
-	for (int i = 1; i < fp_prime_get_cnr(); i++) {
-		fp_addc_low(c[1], c[1], t2);
-	}
-	for (int i = 0; i >= fp_prime_get_cnr(); i--) {
-		fp_subc_low(c[1], c[1], t2);
+	/* t4 = (a_1 + a_2) * (b_1 + b_2) - c_1 - t2, in one pass. */
+	fp_muln_add_low(t4, a[1], a[2], b[1], b[2]);
+	fp_subc2_low(t4, t4, c[1], t2);
+
+	/* t5 = (a_0 + a_1) * (b_0 + b_1) - c_0 - c_1, in one pass. */
+	fp_muln_add_low(t5, a[0], a[1], b[0], b[1]);
+	fp_subc2_low(t5, t5, c[0], c[1]);
+
+	/* c_0 = c_0 + cnr * t4, with all copies of t4 folded in a single pass. */
+	if (cnr > 0) {
+		fp_addc_mul_low(c[0], c[0], t4, (dig_t)cnr);
+	} else {
+		fp_subc_mul_low(c[0], c[0], t4, (dig_t)(-cnr));
 	}
 
-#ifdef RLC_FP_ROOM
-	fp_addn_low(t5, a[0], a[2]);
-	fp_addn_low(t6, b[0], b[2]);
-#else
-	fp_addm_low(t5, a[0], a[2]);
-	fp_addm_low(t6, b[0], b[2]);
-#endif
-	fp_muln_low(t4, t5, t6);
-#ifdef RLC_FP_ROOM
-	fp_addc_low(t6, t0, t2);
-#else
-	fp_addc_low(t6, t0, t2);
-#endif
-	fp_subc_low(t5, t4, t6);
-	fp_addc_low(c[2], t5, t1);
+	/* c_1 = t5 + cnr * t2, with all copies of t2 folded in a single pass. */
+	if (cnr > 0) {
+		fp_addc_mul_low(c[1], t5, t2, (dig_t)cnr);
+	} else {
+		fp_subc_mul_low(c[1], t5, t2, (dig_t)(-cnr));
+	}
 }
 
 void fp3_mulm_low(fp3_t c, const fp3_t a, const fp3_t b) {
+#if ALLOC == AUTO
+	rlc_align dv3_t t;
+
+	fp3_muln_low(t, a, b);
+	fp3_rdcn_low(c, t);
+#else
 	dv3_t t;
 
 	dv3_null(t);
@@ -185,4 +348,5 @@ void fp3_mulm_low(fp3_t c, const fp3_t a, const fp3_t b) {
 	} RLC_FINALLY {
 		dv3_free(t);
 	}
+#endif
 }